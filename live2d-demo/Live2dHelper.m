@@ -10,6 +10,7 @@
 #include <Live2DCubismCore.h>
 #include <Live2DCubismFramework.h>
 #include <Live2DCubismGlRendering.h>
+#include <Live2DCubismScheduling.h>
 #include "Allocation.h"
 #import <UIKit/UIKit.h>
 #import <GLKit/GLKit.h>
@@ -65,6 +66,134 @@ static void InitializeVp(GLfloat* vp, float windowWidth, float windowHeight, flo
 }
 
 
+/// Allocates memory for cached assets.
+///
+/// @param  size       Number of bytes to allocate.
+/// @param  alignment  Alignment for memory block.
+/// @param  userData   Unused.
+///
+/// @return  Valid address to allocated memory on success; '0' otherwise.
+static void* AllocateAsset(const unsigned int size, const unsigned int alignment, void* userData)
+{
+    return AllocateAligned(size, alignment);
+}
+
+/// Frees memory of cached assets.
+///
+/// @param  address   Memory to free.
+/// @param  userData  Unused.
+static void DeallocateAsset(void* address, void* userData)
+{
+    DeallocateAligned(address);
+}
+
+
+/// Maximum number of assets cached at the same time.
+#define AssetCacheCapacity 16
+
+
+/// Gets the asset cache shared by all helpers (living as long as the app).
+///
+/// @return  Asset cache on success; '0' otherwise.
+static csmAssetCache* GetAssetCache(void)
+{
+    static csmAssetCache* cache = 0;
+    unsigned int size;
+    void* address;
+    
+    
+    if (!cache)
+    {
+        size = csmGetSizeofAssetCache(AssetCacheCapacity);
+        address = malloc(size);
+        
+        
+        if (!address)
+        {
+            return 0;
+        }
+        
+        
+        cache = csmInitializeAssetCacheInPlace(AssetCacheCapacity, AllocateAsset, DeallocateAsset, 0, address, size);
+        
+        
+        if (!cache)
+        {
+            free(address);
+        }
+    }
+    
+    
+    return cache;
+}
+
+
+/// Renderer owning the UV and index buffers shared by all helpers.
+static csmGlRenderer* GeometrySource = 0;
+
+/// Number of helpers using the geometry source.
+static int GeometrySourceUserCount = 0;
+
+
+/// Acquires the renderer whose static buffers all helpers share (creating it on first use).
+///
+/// @param  model  Model instantiated from the moc all helpers render.
+///
+/// @return  Geometry source on success; '0' otherwise.
+static csmGlRenderer* AcquireGeometrySource(const csmModel* model)
+{
+    unsigned int size;
+    void* address;
+    
+    
+    if (!GeometrySource)
+    {
+        size = csmGetSizeofGlRenderer(model);
+        address = AllocateAligned(size, sizeof(void*));
+        
+        
+        if (!address)
+        {
+            return 0;
+        }
+        
+        
+        GeometrySource = csmMakeGlRendererInPlace(model, address, size);
+        
+        
+        if (!GeometrySource)
+        {
+            DeallocateAligned(address);
+            
+            
+            return 0;
+        }
+    }
+    
+    
+    ++GeometrySourceUserCount;
+    
+    
+    return GeometrySource;
+}
+
+/// Releases the geometry source (freeing it when the last helper is done with it).
+static void ReleaseGeometrySource(void)
+{
+    if (--GeometrySourceUserCount)
+    {
+        return;
+    }
+    
+    
+    csmReleaseGlRenderer(GeometrySource);
+    DeallocateAligned(GeometrySource);
+    
+    
+    GeometrySource = 0;
+}
+
+
 // -------------- //
 // IMPLEMENTATION //
 // -------------- //
@@ -79,11 +208,10 @@ const GLfloat* GetViewProjectionMatrix()
 }
 
 @interface Live2dHelper() {
-    csmMoc *moc;
-    csmModel *model;
-    csmModelHashTable *table;
-    csmAnimation *animation;
-    csmAnimationState animationState;
+    const csmMoc *moc;
+    const csmBoundAnimation *boundAnimation;
+    csmArena *arena;
+    csmScheduledInstance instance;
     csmGlRenderer *render;
     GLuint texture;
 }
@@ -92,66 +220,93 @@ const GLfloat* GetViewProjectionMatrix()
 @implementation Live2dHelper
 - (instancetype)init {
     self = [super init];
-    if (self) {
-        [self initailize];
+    if (self && ![self initailize]) {
+        return nil;
     }
     return self;
 }
 
-- (void)initailize {
+- (BOOL)initailize {
     csmSetLogFunction(DylanLog);
     CGSize windowSize = [UIScreen mainScreen].bounds.size;
     InitializeVp(Vp, windowSize.width, windowSize.height, 1.0);
     
-    unsigned int mocSize, modelSize, tableSize, renderSize;
-    void *mocMemory = [self readMocMemoryOfsize:&mocSize];
-    moc = csmReviveMocInPlace(mocMemory, mocSize);
+    // Acquire shared assets (files are only read if the cache misses).
+    csmAssetCache *cache = GetAssetCache();
     
-    modelSize = csmGetSizeofModel(moc);
-    void *modelMemory = AllocateAligned(modelSize, csmAlignofModel);
-    model = csmInitializeModelInPlace(moc, modelMemory, modelSize);
+    if (!cache) {
+        return NO;
+    }
     
-    tableSize = csmGetSizeofModelHashTable(model);
-    void *tableMemory = malloc(tableSize);
-    table = csmInitializeModelHashTableInPlace(model, tableMemory, tableSize);
+    NSString *mocPath = [[NSBundle mainBundle] pathForResource:@"Koharu" ofType:@"moc3"];
+    moc = csmAcquireMoc(cache, mocPath.UTF8String, 0, 0);
     
-    const void *motionJson = [self getDataByName:@"Koharu.motion3" ofType:@"json"];
-    const unsigned int animationSize = csmGetDeserializedSizeofAnimation(motionJson);
-    void *animationMemory = malloc(animationSize);
-    animation = csmDeserializeAnimationInPlace(motionJson, animationMemory, animationSize);
+    if (!moc) {
+        NSData *mocData = [[NSData alloc] initWithContentsOfFile:mocPath];
+        moc = csmAcquireMoc(cache, mocPath.UTF8String, mocData.bytes, (unsigned int)mocData.length);
+    }
     
-    csmResetAnimationState(&animationState);
+    if (!moc) {
+        return NO;
+    }
     
-    renderSize = csmGetSizeofGlRenderer(model);
-    void *renderMemory = malloc(renderSize);
-    render = csmMakeGlRendererInPlace(model, renderMemory, renderSize);
+    NSString *motionPath = [[NSBundle mainBundle] pathForResource:@"Koharu.motion3" ofType:@"json"];
+    boundAnimation = csmAcquireAnimation(cache, moc, motionPath.UTF8String, 0);
     
-    texture = [self loadTextureFromPng];
-}
-
-- (const void *)getDataByName:(NSString *)name ofType:(NSString *)type {
-    NSString *path = [[NSBundle mainBundle] pathForResource:name ofType:type];
-    NSData *data = [[NSData alloc] initWithContentsOfFile:path];
-    return [data bytes];
-}
-
-- (void *)readMocMemoryOfsize:(unsigned int*)outSize {
-    void* blob;
-    NSString *path = [[NSBundle mainBundle] pathForResource:@"Koharu" ofType:@"moc3"];
-    NSData *data = [[NSData alloc] initWithContentsOfFile:path];
-    unsigned int size = (unsigned int)data.length;
+    if (!boundAnimation) {
+        NSString *motionJson = [NSString stringWithContentsOfFile:motionPath encoding:NSUTF8StringEncoding error:nil];
+        boundAnimation = csmAcquireAnimation(cache, moc, motionPath.UTF8String, motionJson.UTF8String);
+    }
+    
+    if (!boundAnimation) {
+        return NO;
+    }
+    
+    // Allocate all per-instance state from a single arena.
+    const csmModel *templateModel = csmGetCachedModel(cache, moc);
     
+    if (!templateModel) {
+        return NO;
+    }
+    
+    unsigned int renderSize = csmGetSizeofGlRenderer(templateModel);
+    unsigned int arenaSize = csmGetSizeofArena(csmGetSizeofScheduledInstance(moc, templateModel, boundAnimation, 0) + renderSize + (sizeof(void*) - 1));
+    void *arenaMemory = AllocateAligned(arenaSize, csmAlignofArena);
+    
+    if (!arenaMemory) {
+        return NO;
+    }
+    
+    arena = csmInitializeArenaInPlace(arenaMemory, arenaSize);
+    
+    if (!arena) {
+        DeallocateAligned(arenaMemory);
+        return NO;
+    }
+    
+    if (!csmSpawnScheduledInstance(&instance, moc, boundAnimation, 0, 0, arena)) {
+        return NO;
+    }
+    
+    csmResetAnimationState(instance.AnimationState);
+    
+    // Borrow UV and index buffers from the renderer shared by all helpers.
+    csmGlRenderer *geometrySource = AcquireGeometrySource(templateModel);
+    
+    if (!geometrySource) {
+        return NO;
+    }
     
-    // Allocate aligned memory for moc.
-    blob = AllocateAligned(size, csmAlignofMoc);
-    [data getBytes:blob length:data.length];
+    render = csmMakeGlRendererSharingGeometryInPlace(instance.Model, geometrySource, csmAllocateFromArena(arena, renderSize, sizeof(void*)), renderSize);
     
-    // Store size.
-    if (outSize) {
-        (*outSize) = size;
+    if (!render) {
+        ReleaseGeometrySource();
+        return NO;
     }
     
-    return blob;
+    texture = [self loadTextureFromPng];
+    
+    return YES;
 }
 
 - (GLuint)loadTextureFromPng {
@@ -209,17 +364,39 @@ const GLfloat* GetViewProjectionMatrix()
 }
 
 - (void)onTick:(NSTimeInterval)duration {
-    csmUpdateAnimationState(&animationState, duration);
-    csmEvaluateAnimationFAST(animation, &animationState, csmOverrideFloatBlendFunction, 1.0f, model, table, 0, 0);
+    csmUpdateAnimationState(instance.AnimationState, duration);
+    csmEvaluateBoundAnimation(boundAnimation, instance.AnimationState, instance.AnimationCursor, csmOverrideFloatBlendFunction, 1.0f, instance.Model, 0, 0);
     
-    csmUpdateModel(model);
+    csmUpdateModel(instance.Model);
     csmUpdateGlRenderer(render);
-    csmResetDrawableDynamicFlags(model);
+    csmResetDrawableDynamicFlags(instance.Model);
     
     csmGlDraw(render, Vp, &texture);
 }
 
 - (void)dealloc {
-    // TODO: clean up
+    // Release GL resources (the geometry source before the cached model it renders).
+    if (render) {
+        csmReleaseGlRenderer(render);
+        ReleaseGeometrySource();
+    }
+    
+    if (texture) {
+        glDeleteTextures(1, &texture);
+    }
+    
+    // Free per-instance state at once...
+    if (arena) {
+        DeallocateAligned(arena);
+    }
+    
+    // ... and drop references to shared assets.
+    if (boundAnimation) {
+        csmReleaseAsset(GetAssetCache(), boundAnimation);
+    }
+    
+    if (moc) {
+        csmReleaseAsset(GetAssetCache(), moc);
+    }
 }
 @end
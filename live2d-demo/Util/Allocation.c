@@ -43,6 +43,12 @@ void *AllocateAligned(const unsigned int size, const unsigned int alignment)
   allocation = Allocate(size + (unsigned int)offset);
 
 
+  if (!allocation)
+  {
+    return 0;
+  }
+
+
   alignedAddress = (size_t)allocation + sizeof(void*);
 
 